@@ -0,0 +1,32 @@
+/*
+ * Smallest use of the C API: load a program, run it until it halts, and check where it stopped.
+ * Exits with a non-zero status if anything is off, so it doubles as a smoke test.
+ */
+
+#include <stdio.h>
+#include "altair8800.h"
+
+int main(void) {
+    // LAI 42, HLT
+    const uint8_t program[] = {0x06, 0x42, 0x00};
+    altair_machine* machine = altair_create();
+    if (!machine) {
+        fprintf(stderr, "Couldn't create a machine\n");
+        return 1;
+    }
+    altair_write_memory(machine, 0, program, sizeof(program));
+
+    uint64_t executed = 0;
+    altair_event event = altair_run(machine, 1000, &executed);
+    altair_registers registers;
+    altair_get_registers(machine, &registers);
+    altair_destroy(machine);
+
+    if (event != ALTAIR_EVENT_HALT || executed != 2 || registers.a != 0x42 || registers.pc != 3) {
+        fprintf(stderr, "Expected a halt after 2 instructions with a=42 pc=3, got event %d after %llu with a=%x pc=%x\n",
+                event, (unsigned long long)executed, registers.a, registers.pc);
+        return 1;
+    }
+    printf("Halted after %llu instructions with a=%x\n", (unsigned long long)executed, registers.a);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef ALTAIR8800_ALTAIR8800_H
+#define ALTAIR8800_ALTAIR8800_H
+
+/*
+ * C interface to the emulator core, for driving machines in-process without going through the monitor.
+ * Machines are independent of each other; a single machine must only be used from one thread at a time.
+ * Nothing is printed to the console; results come back through return values and events.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ALTAIR_API marks what the library exports; everything else in it is hidden
+#if defined(_WIN32) && defined(ALTAIR_SHARED)
+#ifdef ALTAIR_BUILDING
+#define ALTAIR_API __declspec(dllexport)
+#else
+#define ALTAIR_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define ALTAIR_API __attribute__((visibility("default")))
+#else
+#define ALTAIR_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALTAIR_RAM_SIZE (16 * 1024)
+#define ALTAIR_STACK_SIZE 7
+
+typedef struct altair_machine altair_machine;
+
+typedef struct altair_registers {
+    uint8_t a, b, c, d, e, h, l;
+    uint16_t pc;
+    uint16_t stack[ALTAIR_STACK_SIZE];
+    uint8_t sp; // number of entries on the stack
+    uint8_t carry, zero, sign, parity; // 0 or 1
+} altair_registers;
+
+typedef enum altair_event {
+    ALTAIR_EVENT_NONE = 0, // ran all the instructions asked for
+    ALTAIR_EVENT_HALT, // the CPU halted
+    ALTAIR_EVENT_IDLE // the CPU is stuck in a loop it can't leave without an interrupt
+} altair_event;
+
+/** Create a machine with zeroed memory and registers. Returns NULL if it couldn't be allocated. */
+ALTAIR_API altair_machine* altair_create(void);
+ALTAIR_API void altair_destroy(altair_machine* machine);
+/** Zero memory and registers, as if freshly created. */
+ALTAIR_API void altair_reset(altair_machine* machine);
+
+/** Copy memory out of the machine. Stops at the end of RAM; returns the number of bytes copied. */
+ALTAIR_API size_t altair_read_memory(const altair_machine* machine, uint16_t address, uint8_t* buffer, size_t length);
+/** Copy memory into the machine. Stops at the end of RAM; returns the number of bytes copied. */
+ALTAIR_API size_t altair_write_memory(altair_machine* machine, uint16_t address, const uint8_t* buffer, size_t length);
+
+ALTAIR_API void altair_get_registers(const altair_machine* machine, altair_registers* registers);
+ALTAIR_API void altair_set_registers(altair_machine* machine, const altair_registers* registers);
+
+/**
+ * Run up to count instructions, leaving the halted state first if needed.
+ * Stops early if the CPU halts or gets stuck in an idle loop. If executed isn't NULL, the number of instructions
+ * actually run is stored there.
+ */
+ALTAIR_API altair_event altair_run(altair_machine* machine, uint64_t count, uint64_t* executed);
+/** Jam a single byte instruction (usually an RST) into the CPU, like the interrupt hardware does. */
+ALTAIR_API void altair_interrupt(altair_machine* machine, uint8_t opcode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ALTAIR8800_ALTAIR8800_H
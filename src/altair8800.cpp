@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <new>
+#include "altair8800.h"
+#include "i8008.h"
+#include "runner.h"
+
+static_assert(ALTAIR_RAM_SIZE == RAM_SIZE, "C API and core disagree on the RAM size");
+static_assert(ALTAIR_STACK_SIZE == STACK_SIZE, "C API and core disagree on the stack size");
+
+struct altair_machine {
+    Intel8008 cpu;
+    IdleDetector idle;
+};
+
+altair_machine* altair_create(void) {
+    altair_machine* machine = new(std::nothrow) altair_machine();
+    if (machine) machine->cpu.consoleOutput = false; // the host program decides what to tell its user
+    return machine;
+}
+
+void altair_destroy(altair_machine* machine) {
+    delete machine;
+}
+
+void altair_reset(altair_machine* machine) {
+    machine->cpu.reset();
+    machine->idle.reset();
+}
+
+size_t altair_read_memory(const altair_machine* machine, uint16_t address, uint8_t* buffer, size_t length) {
+    if (address >= RAM_SIZE) return 0;
+    length = std::min(length, size_t(RAM_SIZE - address));
+    std::copy_n(machine->cpu.memory.begin() + address, length, buffer);
+    return length;
+}
+
+size_t altair_write_memory(altair_machine* machine, uint16_t address, const uint8_t* buffer, size_t length) {
+    if (address >= RAM_SIZE) return 0;
+    length = std::min(length, size_t(RAM_SIZE - address));
+    std::copy_n(buffer, length, machine->cpu.memory.begin() + address);
+    return length;
+}
+
+void altair_get_registers(const altair_machine* machine, altair_registers* registers) {
+    const Registers& source = machine->cpu.registers;
+    registers->a = source.a;
+    registers->b = source.b;
+    registers->c = source.c;
+    registers->d = source.d;
+    registers->e = source.e;
+    registers->h = source.h;
+    registers->l = source.l;
+    registers->pc = source.pc;
+    std::copy_n(source.stack, STACK_SIZE, registers->stack);
+    registers->sp = uint8_t(source.sp);
+    registers->carry = source.carry;
+    registers->zero = source.zero;
+    registers->sign = source.sign;
+    registers->parity = source.parity;
+}
+
+void altair_set_registers(altair_machine* machine, const altair_registers* registers) {
+    Registers& dest = machine->cpu.registers;
+    dest.a = registers->a;
+    dest.b = registers->b;
+    dest.c = registers->c;
+    dest.d = registers->d;
+    dest.e = registers->e;
+    dest.h = registers->h;
+    dest.l = registers->l;
+    dest.pc = registers->pc;
+    std::copy_n(registers->stack, STACK_SIZE, dest.stack);
+    dest.sp = std::min<int>(registers->sp, STACK_SIZE);
+    dest.carry = registers->carry != 0;
+    dest.zero = registers->zero != 0;
+    dest.sign = registers->sign != 0;
+    dest.parity = registers->parity != 0;
+}
+
+altair_event altair_run(altair_machine* machine, uint64_t count, uint64_t* executed) {
+    Intel8008& cpu = machine->cpu;
+    altair_event event = ALTAIR_EVENT_NONE;
+    uint64_t ran = 0;
+    cpu.resume();
+    machine->idle.reset(); // memory and registers may have been changed since the last run
+    while (ran < count) {
+        uint16_t pc = cpu.registers.pc;
+        cpu.step();
+        ran++;
+        if (cpu.isHalted()) {
+            event = ALTAIR_EVENT_HALT;
+            break;
+        }
+        if (machine->idle.check(cpu, pc)) {
+            event = ALTAIR_EVENT_IDLE;
+            break;
+        }
+    }
+    if (executed) *executed = ran;
+    return event;
+}
+
+void altair_interrupt(altair_machine* machine, uint8_t opcode) {
+    machine->cpu.interrupt(opcode);
+    machine->idle.reset();
+}
@@ -1,10 +1,24 @@
 #include <iostream>
 #include "i8008.h"
 
+Intel8008::Intel8008() : memory() {
+    halted = true;
+}
+
 Intel8008::Intel8008(std::array<uint8_t, RAM_SIZE>& ram) : memory(ram) {
     halted = true;
 }
 
+/**
+ * Zero memory and registers and halt, like a freshly made CPU.
+ */
+void Intel8008::reset() {
+    memory.fill(0);
+    registers = Registers();
+    memoryWrites = 0;
+    halted = true;
+}
+
 uint8_t Intel8008::read() {
     return memory.at(registers.pc & 0x3fff); // cpu can only address 16KiB of RAM
 }
@@ -18,7 +32,7 @@ void Intel8008::execute(uint8_t opcode) {
     registers.pc += 1; // go ahead and move the program counter up for future reads
     switch (opcode & 0b11000000) { // check the first two bits of the opcode to cut down on unnecessary comparisons
         case 0b00 << 6: {
-            if (opcode & 0b11111110 == 0) { // for some reason, the lowest bit doesn't matter
+            if ((opcode & 0b11111110) == 0) { // for some reason, the lowest bit doesn't matter
                 halt(); // HLT - halt
             } else if (opcode & 0b111 == 0b000 && (opcode & 0b00111000) >> 3 != 0b111) { // cannot increment M
                 // INr - increment register no carry
@@ -89,6 +103,7 @@ void Intel8008::execute(uint8_t opcode) {
                         if ((opcode & 0b00111000) >> 3 == 0b111) {
                             // LMI - load next byte into RAM address M
                             memory[registers.getM()] = nextByte;
+                            memoryWrites++;
                         } else {
                             // LrI - load next byte into register
                             int reg = (opcode & 0b00111000) >> 3;
@@ -321,6 +336,7 @@ void Intel8008::execute(uint8_t opcode) {
             } else if ((opcode & 0b00111000) >> 3 == 0b111) {
                 // LMr - dump register to memory address M
                 memory.at(registers.getM()) = *registers.registerArray[opcode & 0b111];
+                memoryWrites++;
             } else {
                 // Lr1r2 - copy contents of register 2 into register 1
                 int src = opcode & 0b111;
@@ -337,11 +353,31 @@ void Intel8008::execute(uint8_t opcode) {
 }
 
 void Intel8008::halt() {
-    std::cout << "HALT" << std::endl;
+    if (consoleOutput) std::cout << "HALT" << std::endl;
     halted = true;
 }
 
+void Intel8008::resume() {
+    halted = false;
+}
+
+bool Intel8008::isHalted() const {
+    return halted;
+}
+
+/**
+ * Jam a single byte instruction onto the bus, like the interrupt hardware does. Leaves the halted state.
+ * The program counter isn't advanced past the jammed instruction, so an RST pushes the address of the next real one.
+ * @param opcode The instruction to execute, usually an RST
+ */
+void Intel8008::interrupt(uint8_t opcode) {
+    halted = false;
+    registers.pc -= 1; // execute() moves it forwards again
+    execute(opcode);
+}
+
 void Intel8008::unknownOpcode(uint8_t opcode) {
+    if (!consoleOutput) return;
     std::cerr << std::hex << "Unknown opcode " << (int)opcode << " at 0x" << registers.pc - 1 << std::dec << std::endl;
 }
 
@@ -351,7 +387,7 @@ void Intel8008::unknownOpcode(uint8_t opcode) {
  */
 void Intel8008::push(uint16_t value) {
     if (registers.sp >= STACK_SIZE) {
-        std::cerr << "Stack is full, can't push " << value << "!" << std::endl;
+        if (consoleOutput) std::cerr << "Stack is full, can't push " << value << "!" << std::endl;
         return;
     }
     registers.stack[registers.sp++] = uint16_t(value & 0x3fff); // stack values should be 14 bit
@@ -363,7 +399,7 @@ void Intel8008::push(uint16_t value) {
  */
 uint16_t Intel8008::pop() {
     if (registers.sp <= 0) {
-        std::cerr << "Stack is empty, popping program counter!" << std::endl;
+        if (consoleOutput) std::cerr << "Stack is empty, popping program counter!" << std::endl;
         return registers.pc;
     }
     return registers.stack[--registers.sp];
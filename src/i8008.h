@@ -21,6 +21,20 @@ struct Registers {
     bool carry = false; // {over,under}flow
     bool* flagArray[4] = {&carry, &zero, &sign, &parity}; // for access from opcodes
 
+    Registers() = default;
+    // the pointer arrays have to keep pointing at our own fields, so only the values are copied
+    Registers(const Registers& other) {
+        *this = other;
+    }
+    Registers& operator=(const Registers& other) {
+        a = other.a; b = other.b; c = other.c; d = other.d; e = other.e; h = other.h; l = other.l;
+        pc = other.pc;
+        for (int i = 0; i < STACK_SIZE; i++) stack[i] = other.stack[i];
+        sp = other.sp;
+        sign = other.sign; zero = other.zero; parity = other.parity; carry = other.carry;
+        return *this;
+    }
+
     uint16_t getM() {
         return uint16_t(((uint16_t(h) & 0b00111111) << 8) & l); // We only care about the first 6 bits of the H register
     }
@@ -30,11 +44,18 @@ class Intel8008 {
     public:
         Registers registers;
         std::array<uint8_t, RAM_SIZE> memory;
+        uint32_t memoryWrites = 0; // bumped on every store the CPU makes, so observers can spot writes cheaply
+        bool consoleOutput = true; // print HALT and errors to the console; embedders turn this off
+        Intel8008();
         explicit Intel8008(std::array<uint8_t, RAM_SIZE>& ram);
+        void reset();
         void step();
         void execute(uint8_t opcode);
         uint8_t read();
         void halt();
+        void resume();
+        bool isHalted() const;
+        void interrupt(uint8_t opcode);
         void unknownOpcode(uint8_t opcode);
         void push(uint16_t value);
         uint16_t pop();
@@ -0,0 +1,451 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <exception>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "debugserver.h"
+#include "../utils.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS and the BSDs don't have it, SO_NOSIGPIPE is set on the socket there instead
+#endif
+
+static constexpr int REGISTER_BYTES = 25;
+
+static void appendHex(std::string& out, uint8_t byte) {
+    static const char digits[] = "0123456789abcdef";
+    out += digits[byte >> 4];
+    out += digits[byte & 0xf];
+}
+
+static void appendPacket(std::string& out, const std::string& data) {
+    uint8_t checksum = 0;
+    for (char ch : data) checksum += uint8_t(ch);
+    out += '$';
+    out += data;
+    out += '#';
+    appendHex(out, checksum);
+}
+
+/**
+ * Send everything, however many writes it takes.
+ * @return False if the client has gone away
+ */
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return false;
+        sent += result;
+    }
+    return true;
+}
+
+/**
+ * Parse the "addr,length" that starts m, M and X packets.
+ * @return Where the rest of the packet starts
+ */
+static size_t parseRange(const std::string& packet, unsigned long& address, unsigned long& length) {
+    size_t comma = packet.find(',');
+    size_t end = packet.find(':');
+    address = std::stoul(packet.substr(1, comma - 1), nullptr, 16);
+    length = std::stoul(packet.substr(comma + 1, end == std::string::npos ? end : end - comma - 1), nullptr, 16);
+    return end == std::string::npos ? packet.size() : end + 1;
+}
+
+DebugServer::DebugServer(Intel8008& cpu, Runner& runner) : cpu(cpu), runner(runner) {
+}
+
+DebugServer::~DebugServer() {
+    stop();
+}
+
+/**
+ * Listen on a TCP port. Only connections from this machine are accepted.
+ * @return False if the port couldn't be opened, with errno set
+ */
+bool DebugServer::listenTcp(int port) {
+    if (isListening()) stop();
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    int yes = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, 1) < 0) {
+        int error = errno;
+        close(listenFd);
+        listenFd = -1;
+        errno = error;
+        return false;
+    }
+    return begin();
+}
+
+/**
+ * Listen on a Unix socket, replacing a stale socket left at the path. Anything else at the path is left alone.
+ * @return False if the socket couldn't be made, with errno set (EEXIST if something other than a socket is there)
+ */
+bool DebugServer::listenUnix(const std::string& path) {
+    if (isListening()) stop();
+    sockaddr_un address = {};
+    if (path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            errno = EEXIST;
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    if (bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, 1) < 0) {
+        int error = errno;
+        close(listenFd);
+        listenFd = -1;
+        errno = error;
+        return false;
+    }
+    socketPath = path;
+    return begin();
+}
+
+bool DebugServer::begin() {
+    if (pipe(wakePipe) < 0) {
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+    {
+        auto guard = runner.acquire();
+        runner.setStopHandler([this](StopReason reason) {
+            if (reason == StopReason::Halt) halted = true;
+            char byte = 0;
+            (void)!write(wakePipe[1], &byte, 1); // if the pipe is full, a wakeup is already on its way
+        });
+    }
+    quit = false;
+    thread = std::thread(&DebugServer::loop, this);
+    return true;
+}
+
+/**
+ * Stop listening and drop any client. Must not be called while holding the runner's lock.
+ */
+void DebugServer::stop() {
+    if (!thread.joinable()) return;
+    quit = true;
+    char byte = 0;
+    (void)!write(wakePipe[1], &byte, 1);
+    thread.join();
+    {
+        auto guard = runner.acquire();
+        runner.setStopHandler(nullptr);
+    }
+    close(listenFd);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    listenFd = wakePipe[0] = wakePipe[1] = -1;
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+    socketPath.clear();
+}
+
+bool DebugServer::isListening() {
+    return thread.joinable();
+}
+
+void DebugServer::loop() {
+    char drain[64];
+    while (!quit) {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            while (read(wakePipe[0], drain, sizeof(drain)) > 0); // nobody to tell about stops
+        }
+        if (quit) break;
+        if (fds[0].revents & POLLIN) {
+            clientFd = accept(listenFd, nullptr, nullptr);
+            if (clientFd < 0) continue;
+            serveClient();
+            close(clientFd);
+            clientFd = -1;
+        }
+    }
+}
+
+void DebugServer::serveClient() {
+    int yes = 1;
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)); // fails harmlessly on Unix sockets
+#ifdef SO_NOSIGPIPE
+    setsockopt(clientFd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes)); // a client going away shouldn't kill us
+#endif
+    ackMode = true;
+    waitingForStop = false;
+    input.clear();
+    char buffer[64 * 1024];
+    while (!quit) {
+        pollfd fds[2] = {{clientFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        std::string output;
+        bool open = true;
+        if (fds[1].revents & POLLIN) {
+            while (read(wakePipe[0], buffer, sizeof(buffer)) > 0);
+            if (quit) return;
+            auto guard = runner.acquire();
+            if (halted.exchange(false) && waitingForStop) runner.stop(); // a halted CPU is a stopped one to a debugger
+            if (waitingForStop && !runner.isRunning()) sendStop(output);
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t received = recv(clientFd, buffer, sizeof(buffer), 0);
+            if (received <= 0) return;
+            input.append(buffer, received);
+            auto guard = runner.acquire();
+            open = process(output);
+        }
+        if (!output.empty() && !sendAll(clientFd, output)) return;
+        if (!open) return;
+    }
+}
+
+/**
+ * Handle every complete packet in the input, holding the CPU for the whole batch.
+ * @param output Acks and replies get appended to this
+ * @return False if the client asked to disconnect
+ */
+bool DebugServer::process(std::string& output) {
+    bool open = true;
+    bool changed = false;
+    size_t pos = 0;
+    while (pos < input.size() && open) {
+        char ch = input[pos];
+        if (ch == 0x03) {
+            // out of band interrupt
+            pos++;
+            runner.stop();
+            if (waitingForStop) {
+                waitingForStop = false;
+                appendPacket(output, "S02");
+            }
+            continue;
+        }
+        if (ch != '$') { // acks, or noise between packets
+            pos++;
+            continue;
+        }
+        size_t hash = input.find('#', pos);
+        if (hash == std::string::npos || hash + 2 >= input.size()) break; // the rest hasn't arrived yet
+        std::string packet = input.substr(pos + 1, hash - pos - 1);
+        uint8_t checksum = 0;
+        for (char c : packet) checksum += uint8_t(c);
+        std::vector<uint8_t> expected;
+        pos = hash + 3;
+        if (ackMode && (!Altair8008Utils::parseHexBytes(input.substr(hash + 1, 2), expected) || expected[0] != checksum)) {
+            output += '-';
+            continue;
+        }
+        if (ackMode) output += '+';
+        if (packet.empty()) continue;
+        std::string reply;
+        bool respond;
+        try {
+            respond = handle(packet, reply, changed);
+        } catch (const std::exception&) { // malformed numbers
+            reply = "E01";
+            respond = true;
+        }
+        if (respond) appendPacket(output, reply);
+        open = packet[0] != 'k' && packet[0] != 'D';
+    }
+    input.erase(0, pos);
+    if (input.size() > DEBUG_PACKET_SIZE) {
+        // bigger than the PacketSize we advertised and still not finished, so it's never going to be valid
+        input.clear();
+        output += '-';
+    }
+    if (changed) runner.wake(); // memory or registers changed under a possibly parked CPU, reads leave it parked
+    return open;
+}
+
+/**
+ * Handle one packet.
+ * @param reply What to send back
+ * @param changed Set if the packet changed memory, registers, breakpoints or whether the CPU is running
+ * @return False if there's nothing to send back yet
+ */
+bool DebugServer::handle(const std::string& packet, std::string& reply, bool& changed) {
+    switch (packet[0]) {
+        case '?': {
+            reply = "S05";
+            return true;
+        }
+        case 'g': {
+            const Registers& registers = cpu.registers;
+            for (int i = 0; i < 7; i++) appendHex(reply, *registers.registerArray[i]);
+            appendHex(reply, registers.carry | registers.zero << 1 | registers.sign << 2 | registers.parity << 3);
+            appendHex(reply, registers.sp);
+            appendHex(reply, registers.pc & 0xff);
+            appendHex(reply, registers.pc >> 8);
+            for (uint16_t entry : registers.stack) {
+                appendHex(reply, entry & 0xff);
+                appendHex(reply, entry >> 8);
+            }
+            return true;
+        }
+        case 'G': {
+            std::vector<uint8_t> bytes;
+            if (!Altair8008Utils::parseHexBytes(packet.substr(1), bytes) || bytes.size() != REGISTER_BYTES || bytes[8] > STACK_SIZE) {
+                reply = "E01";
+                return true;
+            }
+            Registers& registers = cpu.registers;
+            for (int i = 0; i < 7; i++) *registers.registerArray[i] = bytes[i];
+            registers.carry = bytes[7] & 1;
+            registers.zero = bytes[7] & 2;
+            registers.sign = bytes[7] & 4;
+            registers.parity = bytes[7] & 8;
+            registers.sp = bytes[8];
+            registers.pc = uint16_t(bytes[9] | bytes[10] << 8);
+            for (int i = 0; i < STACK_SIZE; i++) registers.stack[i] = uint16_t(bytes[11 + i * 2] | bytes[12 + i * 2] << 8);
+            reply = "OK";
+            changed = true;
+            return true;
+        }
+        case 'm': {
+            unsigned long address, length;
+            parseRange(packet, address, length);
+            if (address >= RAM_SIZE) {
+                reply = "E01";
+                return true;
+            }
+            length = std::min(length, RAM_SIZE - address);
+            reply.reserve(length * 2);
+            for (unsigned long i = 0; i < length; i++) appendHex(reply, cpu.memory[address + i]);
+            return true;
+        }
+        case 'M': {
+            unsigned long address, length;
+            size_t data = parseRange(packet, address, length);
+            std::vector<uint8_t> bytes;
+            if (length > 0 && !Altair8008Utils::parseHexBytes(packet.substr(data), bytes)) {
+                reply = "E01";
+                return true;
+            }
+            if (bytes.size() != length || address >= RAM_SIZE || length > RAM_SIZE - address) {
+                reply = "E01";
+                return true;
+            }
+            std::copy(bytes.begin(), bytes.end(), cpu.memory.begin() + address);
+            reply = "OK";
+            changed = true;
+            return true;
+        }
+        case 'X': {
+            // like M, but the data is binary with }, #, $ and * escaped as } followed by the byte xor 0x20
+            unsigned long address, length;
+            size_t data = parseRange(packet, address, length);
+            std::vector<uint8_t> bytes;
+            for (size_t i = data; i < packet.size(); i++) {
+                if (packet[i] == '}' && i + 1 < packet.size()) {
+                    bytes.push_back(uint8_t(packet[++i]) ^ 0x20);
+                } else {
+                    bytes.push_back(uint8_t(packet[i]));
+                }
+            }
+            if (bytes.size() != length || address >= RAM_SIZE || length > RAM_SIZE - address) {
+                reply = "E01";
+                return true;
+            }
+            std::copy(bytes.begin(), bytes.end(), cpu.memory.begin() + address);
+            reply = "OK";
+            changed = true;
+            return true;
+        }
+        case 'Z':
+        case 'z': {
+            // software and hardware breakpoints are the same thing to us
+            if (packet.size() < 2 || (packet[1] != '0' && packet[1] != '1')) return true; // watchpoints aren't supported
+            unsigned long address = std::stoul(packet.substr(3), nullptr, 16);
+            if (address >= RAM_SIZE) {
+                reply = "E01";
+                return true;
+            }
+            runner.setBreakpoint(address, packet[0] == 'Z');
+            reply = "OK";
+            changed = true;
+            return true;
+        }
+        case 's': {
+            runner.stop();
+            if (packet.size() > 1) cpu.registers.pc = std::stoul(packet.substr(1), nullptr, 16);
+            cpu.step();
+            changed = true;
+            reply = "S05";
+            return true;
+        }
+        case 'c': {
+            if (packet.size() > 1) cpu.registers.pc = std::stoul(packet.substr(1), nullptr, 16);
+            halted = false;
+            waitingForStop = true;
+            runner.start();
+            changed = true;
+            return false; // answered when the CPU stops
+        }
+        case 'k': {
+            return false;
+        }
+        case 'D':
+        case 'H': {
+            reply = "OK";
+            return true;
+        }
+        case 'q': {
+            if (packet.compare(0, 10, "qSupported") == 0) {
+                char supported[64];
+                snprintf(supported, sizeof(supported), "PacketSize=%x;QStartNoAckMode+", DEBUG_PACKET_SIZE);
+                reply = supported;
+            } else if (packet == "qAttached") {
+                reply = "1";
+            }
+            return true;
+        }
+        case 'Q': {
+            if (packet == "QStartNoAckMode") {
+                ackMode = false; // this packet still gets acked, it's already been done
+                reply = "OK";
+            }
+            return true;
+        }
+        default: {
+            return true; // an empty reply means unsupported
+        }
+    }
+}
+
+void DebugServer::sendStop(std::string& output) {
+    waitingForStop = false;
+    appendPacket(output, "S05");
+}
@@ -0,0 +1,53 @@
+#ifndef ALTAIR8800_DEBUGSERVER_H
+#define ALTAIR8800_DEBUGSERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "../i8008.h"
+#include "../runner.h"
+
+constexpr int DEBUG_DEFAULT_PORT = 8008;
+constexpr int DEBUG_PACKET_SIZE = 0x8100; // big enough to write all of RAM as hex in one M packet
+
+/**
+ * Serves a GDB remote protocol style debugger over a local TCP port or Unix socket, one client at a time.
+ * Every complete packet in what the client has sent is answered in a single write, so clients can pipeline as
+ * many requests as they like per round trip.
+ *
+ * Supported packets: ? g G m M X Z0/z0 (also Z1/z1) s c k D qSupported qAttached QStartNoAckMode H, and a bare
+ * 0x03 byte to stop a running CPU. Registers in g/G are sent as 25 bytes:
+ *   a b c d e h l, flags (carry | zero << 1 | sign << 2 | parity << 3), sp, pc (little endian),
+ *   then the 7 stack entries (little endian)
+ */
+class DebugServer {
+    public:
+        DebugServer(Intel8008& cpu, Runner& runner);
+        ~DebugServer();
+        bool listenTcp(int port);
+        bool listenUnix(const std::string& path);
+        void stop();
+        bool isListening();
+
+    private:
+        Intel8008& cpu;
+        Runner& runner;
+        int listenFd = -1;
+        int clientFd = -1;
+        int wakePipe[2] = {-1, -1}; // written to when the CPU stops or the server should quit
+        std::string socketPath; // unlinked on stop if we made a Unix socket
+        std::thread thread;
+        std::atomic<bool> quit{false};
+        std::atomic<bool> halted{false}; // the last stop reported by the runner was a halt
+        bool ackMode = true;
+        bool waitingForStop = false; // a c packet hasn't been answered yet
+        std::string input;
+        bool begin();
+        void loop();
+        void serveClient();
+        bool process(std::string& output);
+        bool handle(const std::string& packet, std::string& reply, bool& changed);
+        void sendStop(std::string& output);
+};
+
+#endif //ALTAIR8800_DEBUGSERVER_H
@@ -1,45 +1,100 @@
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include "monitor.h"
+#include "../memops.h"
 #include "../utils.h"
 
-Monitor::Monitor(Intel8008 cpu) : cpu(cpu) {
+#ifdef ALTAIR8800_DEBUG_SERVER
+Monitor::Monitor(Intel8008 cpu) : cpu(cpu), runner(this->cpu), debugServer(this->cpu, runner) {
 }
+#else
+Monitor::Monitor(Intel8008 cpu) : cpu(cpu), runner(this->cpu) {
+}
+#endif
 
 void Monitor::run() {
     std::string command;
     std::vector<std::string> splitCommand;
     while (isRunning) {
         std::cout << MONITOR_PROMPT;
-        std::getline(std::cin, command);
+        if (!std::getline(std::cin, command)) break;
         splitCommand = Altair8008Utils::splitString(command);
-        if (splitCommand.empty()) {
+        if (splitCommand.empty()) continue;
+        if (splitCommand[0] == "debug") {
+            debug(splitCommand); // the debug server takes the CPU itself, so it can't be held here
             continue;
-        } else if (splitCommand[0] == "q" || splitCommand[0] == "quit" || splitCommand[0] == "exit") {
-            isRunning = false;
-            cpu.halt();
-            break;
-        } else if (splitCommand[0] == "e" || splitCommand[0] == "examine" || splitCommand[0] == "peek") {
-            examine(splitCommand);
-        } else if (splitCommand[0] == "dump") {
-            dump(splitCommand);
-        } else if (splitCommand[0] == "h" || splitCommand[0] == "help") {
-            std::string topic = splitCommand.size() > 1 ? splitCommand[1] : "";
-            help(topic);
-        } else if (splitCommand[0] == "deposit" || splitCommand[0] == "d" || splitCommand[0] == "poke") {
-            deposit(splitCommand);
-        } else if (splitCommand[0] == "depositnext" || splitCommand[0] == "dn") {
-            cpu.registers.pc++;
-            deposit(splitCommand);
-        } else if (splitCommand[0] == "step" || splitCommand[0] == "s") {
-            cpu.step();
-        } else if (splitCommand[0] == "load" || splitCommand[0] == "l") {
-            load(splitCommand);
-        } else if (splitCommand[0] == "pc") {
-            std::cout << std::hex << (int)cpu.registers.pc << std::dec << std::endl;
-        } else {
-            std::cout << "Unknown command. Type \"help\" for a list of valid commands." << std::endl;
         }
+        // the CPU may be running on its own thread, so take it for the length of the command
+        auto guard = runner.acquire();
+        execute(splitCommand);
+        if (changesMachine(splitCommand)) runner.wake(); // let a parked CPU see what the command did
+    }
+}
+
+/**
+ * Check if a command can change memory or registers, which a parked CPU needs to know about.
+ * Commands that only look (examine without an address, help, idle...) leave a parked CPU alone.
+ */
+bool Monitor::changesMachine(const std::vector<std::string>& splitCommand) {
+    static const std::vector<std::string> changing {
+        "deposit", "d", "poke", "depositnext", "dn", "step", "s", "load", "l",
+        "fill", "move", "mv", "interrupt", "int", "run", "r"
+    };
+    const std::string& command = splitCommand[0];
+    if (command == "e" || command == "examine" || command == "peek") {
+        return splitCommand.size() > 1; // moves the program counter
+    }
+    return std::find(changing.begin(), changing.end(), command) != changing.end();
+}
+
+void Monitor::execute(const std::vector<std::string>& splitCommand) {
+    if (splitCommand[0] == "q" || splitCommand[0] == "quit" || splitCommand[0] == "exit") {
+        isRunning = false;
+        runner.stop();
+        cpu.halt();
+    } else if (splitCommand[0] == "e" || splitCommand[0] == "examine" || splitCommand[0] == "peek") {
+        examine(splitCommand);
+    } else if (splitCommand[0] == "dump") {
+        dump(splitCommand);
+    } else if (splitCommand[0] == "h" || splitCommand[0] == "help") {
+        std::string topic = splitCommand.size() > 1 ? splitCommand[1] : "";
+        help(topic);
+    } else if (splitCommand[0] == "deposit" || splitCommand[0] == "d" || splitCommand[0] == "poke") {
+        deposit(splitCommand);
+    } else if (splitCommand[0] == "depositnext" || splitCommand[0] == "dn") {
+        cpu.registers.pc++;
+        deposit(splitCommand);
+    } else if (splitCommand[0] == "step" || splitCommand[0] == "s") {
+        cpu.step();
+    } else if (splitCommand[0] == "load" || splitCommand[0] == "l") {
+        load(splitCommand);
+    } else if (splitCommand[0] == "pc") {
+        std::cout << std::hex << (int)cpu.registers.pc << std::dec << std::endl;
+    } else if (splitCommand[0] == "run" || splitCommand[0] == "r") {
+        runner.start();
+    } else if (splitCommand[0] == "stop") {
+        runner.stop();
+    } else if (splitCommand[0] == "interrupt" || splitCommand[0] == "int") {
+        interrupt(splitCommand);
+    } else if (splitCommand[0] == "idle") {
+        idle();
+    } else if (splitCommand[0] == "find" || splitCommand[0] == "f") {
+        find(splitCommand);
+    } else if (splitCommand[0] == "fill") {
+        fill(splitCommand);
+    } else if (splitCommand[0] == "move" || splitCommand[0] == "mv") {
+        move(splitCommand);
+    } else if (splitCommand[0] == "snapshot" || splitCommand[0] == "snap") {
+        snapshot = cpu.memory;
+        hasSnapshot = true;
+    } else if (splitCommand[0] == "compare" || splitCommand[0] == "cmp") {
+        compare(splitCommand);
+    } else {
+        std::cout << "Unknown command. Type \"help\" for a list of valid commands." << std::endl;
     }
 }
 
@@ -175,6 +230,182 @@ void Monitor::load(const std::vector<std::string>& splitCommand) {
     }
 }
 
+void Monitor::interrupt(const std::vector<std::string>& splitCommand) {
+    switch (splitCommand.size() - 1) { // amount of arguments
+        case 0: {
+            runner.interrupt(0x05); // RST 0
+            break;
+        }
+        case 1: {
+            int opcode = std::stoi(splitCommand[1], nullptr, 16);
+            if (opcode > 0xff || opcode < 0) {
+                std::cout << "Opcode out of range. Valid values are 0-ff." << std::endl;
+            } else {
+                runner.interrupt(opcode);
+            }
+            break;
+        }
+        default: {
+            help("interrupt");
+            break;
+        }
+    }
+}
+
+void Monitor::idle() {
+    double parked = std::chrono::duration<double, std::milli>(runner.parkedTime()).count();
+    double ran = std::chrono::duration<double, std::milli>(runner.runTime()).count();
+    std::cout << (runner.isRunning() ? (runner.isParked() ? "Parked" : "Running") : "Stopped") << std::endl;
+    printf("Parked %.3fms of %.3fms run time (%.1f%%) over %lu parks\n", parked, ran, ran > 0 ? parked / ran * 100 : 0.0, runner.parkCount());
+}
+
+void Monitor::find(const std::vector<std::string>& splitCommand) {
+    if (splitCommand.size() < 2) {
+        help("find");
+        return;
+    }
+    std::vector<uint8_t> pattern;
+    for (size_t i = 1; i < splitCommand.size(); i++) {
+        if (!Altair8008Utils::parseHexBytes(splitCommand[i], pattern)) {
+            std::cout << splitCommand[i] << " isn't a valid byte pattern. Enter pairs of hex digits." << std::endl;
+            return;
+        }
+    }
+    long address = Altair8008Memory::find(cpu.memory.data(), RAM_SIZE, pattern.data(), pattern.size());
+    if (address < 0) {
+        std::cout << "Not found." << std::endl;
+        return;
+    }
+    while (address >= 0) {
+        printf("%04lx ", address);
+        address = Altair8008Memory::find(cpu.memory.data(), RAM_SIZE, pattern.data(), pattern.size(), address + 1);
+    }
+    std::cout << std::endl;
+}
+
+void Monitor::fill(const std::vector<std::string>& splitCommand) {
+    switch (splitCommand.size() - 1) { // amount of arguments
+        case 3: {
+            int start = std::stoi(splitCommand[1], nullptr, 16);
+            int end = std::stoi(splitCommand[2], nullptr, 16);
+            int value = std::stoi(splitCommand[3], nullptr, 16);
+            if (start >= RAM_SIZE || start < 0 || end >= RAM_SIZE || end < 0) {
+                std::cout << "Addresses out of range. Valid values are 0-" << std::hex << RAM_SIZE - 1 << std::dec << "." << std::endl;
+            } else if (start > end) {
+                std::cout << "Start address is greater than end address." << std::endl;
+            } else if (value > 0xff || value < 0) {
+                std::cout << "Value out of range. Valid values are 0-ff." << std::endl;
+            } else {
+                Altair8008Memory::fill(cpu.memory.data() + start, end - start + 1, value);
+            }
+            break;
+        }
+        default: {
+            help("fill");
+            break;
+        }
+    }
+}
+
+void Monitor::move(const std::vector<std::string>& splitCommand) {
+    switch (splitCommand.size() - 1) { // amount of arguments
+        case 3: {
+            int source = std::stoi(splitCommand[1], nullptr, 16);
+            int dest = std::stoi(splitCommand[2], nullptr, 16);
+            int length = std::stoi(splitCommand[3], nullptr, 16);
+            if (source < 0 || dest < 0 || length < 0 || source >= RAM_SIZE || dest >= RAM_SIZE ||
+                length > RAM_SIZE - source || length > RAM_SIZE - dest) {
+                std::cout << "Block out of range. Valid addresses are 0-" << std::hex << RAM_SIZE - 1 << std::dec << "." << std::endl;
+            } else {
+                Altair8008Memory::move(cpu.memory.data(), source, dest, length);
+            }
+            break;
+        }
+        default: {
+            help("move");
+            break;
+        }
+    }
+}
+
+void Monitor::compare(const std::vector<std::string>& splitCommand) {
+    std::array<uint8_t, RAM_SIZE> other = {};
+    size_t length = RAM_SIZE;
+    if (splitCommand.size() == 1 || (splitCommand.size() == 2 && splitCommand[1] == "snapshot")) {
+        if (!hasSnapshot) {
+            std::cout << "No snapshot taken. Type \"snapshot\" to take one." << std::endl;
+            return;
+        }
+        other = snapshot;
+    } else if (splitCommand.size() == 2) {
+        std::ifstream file(splitCommand[1], std::ios::in|std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Couldn't open " << splitCommand[1] << std::endl;
+            return;
+        }
+        file.read((char *)other.data(), other.size());
+        length = file.gcount(); // only compare as much as the file covers
+    } else {
+        help("compare");
+        return;
+    }
+    auto ranges = Altair8008Memory::compare(cpu.memory.data(), other.data(), length);
+    if (ranges.empty()) {
+        std::cout << "No differences." << std::endl;
+    }
+    for (const auto& range : ranges) {
+        if (range.first == range.second) {
+            printf("%04zx\n", range.first);
+        } else {
+            printf("%04zx-%04zx\n", range.first, range.second);
+        }
+    }
+}
+
+void Monitor::debug(const std::vector<std::string>& splitCommand) {
+#ifndef ALTAIR8800_DEBUG_SERVER
+    std::cout << "The debug server isn't available on this platform." << std::endl;
+    return;
+#else
+    switch (splitCommand.size() - 1) { // amount of arguments
+        case 0: {
+            if (debugServer.listenTcp(DEBUG_DEFAULT_PORT)) {
+                std::cout << "Debug server listening on port " << DEBUG_DEFAULT_PORT << "." << std::endl;
+            } else {
+                std::cerr << "Couldn't listen on port " << DEBUG_DEFAULT_PORT << ": " << std::strerror(errno) << std::endl;
+            }
+            break;
+        }
+        case 1: {
+            const std::string& where = splitCommand[1];
+            if (where == "off") {
+                debugServer.stop();
+            } else if (where.find_first_not_of("0123456789") != std::string::npos) {
+                if (debugServer.listenUnix(where)) {
+                    std::cout << "Debug server listening on " << where << "." << std::endl;
+                } else {
+                    std::cerr << "Couldn't listen on " << where << ": " << (errno == EEXIST ? "path exists" : std::strerror(errno)) << std::endl;
+                }
+            } else {
+                int port = std::stoi(where);
+                if (port <= 0 || port > 0xffff) {
+                    std::cout << "Port out of range." << std::endl;
+                } else if (debugServer.listenTcp(port)) {
+                    std::cout << "Debug server listening on port " << port << "." << std::endl;
+                } else {
+                    std::cerr << "Couldn't listen on port " << port << ": " << std::strerror(errno) << std::endl;
+                }
+            }
+            break;
+        }
+        default: {
+            help("debug");
+            break;
+        }
+    }
+#endif
+}
+
 // TODO: find some way to clean this up
 void Monitor::help(const std::string& topic) {
     // not the most elegant system but...
@@ -229,6 +460,54 @@ void Monitor::help(const std::string& topic) {
         std::cout << "pc" << std::endl;
         std::cout << "USAGE:" << std::endl;
         std::cout << "  pc -- see the current address in the program counter" << std::endl;
+    } else if (topic == "run" || topic == "r") {
+        std::cout << "run (also r)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  run -- let the CPU run freely from the program counter until stopped" << std::endl;
+        std::cout << "  the CPU stops using the host when it halts or gets stuck in a loop, until an interrupt or command comes in" << std::endl;
+        std::cout << "see also: stop, idle" << std::endl;
+    } else if (topic == "stop") {
+        std::cout << "stop" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  stop -- stop a running CPU" << std::endl;
+    } else if (topic == "interrupt" || topic == "int") {
+        std::cout << "interrupt (also int)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  interrupt -- interrupt the CPU with RST 0, waking it from a halt" << std::endl;
+        std::cout << "  interrupt [opcode] -- interrupt the CPU with a specific single byte instruction" << std::endl;
+    } else if (topic == "idle") {
+        std::cout << "idle" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  idle -- see how long the CPU has spent parked while halted or looping" << std::endl;
+    } else if (topic == "find" || topic == "f") {
+        std::cout << "find (also f)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  find [pattern] -- list every address where a byte pattern (like c3 00 10, or c30010) appears" << std::endl;
+    } else if (topic == "fill") {
+        std::cout << "fill" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  fill [start] [end] [value] -- set memory between these addresses, inclusive, to a value" << std::endl;
+    } else if (topic == "move" || topic == "mv") {
+        std::cout << "move (also mv)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  move [source] [destination] [length] -- copy a block of memory (the blocks may overlap)" << std::endl;
+    } else if (topic == "snapshot" || topic == "snap") {
+        std::cout << "snapshot (also snap)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  snapshot -- remember the current contents of memory for compare" << std::endl;
+    } else if (topic == "compare" || topic == "cmp") {
+        std::cout << "compare (also cmp)" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  compare -- list address ranges that changed since the last snapshot (same as compare snapshot)" << std::endl;
+        std::cout << "  compare [filename] -- list address ranges that differ from a file loaded at 0x00" << std::endl;
+        std::cout << "see also: snapshot" << std::endl;
+    } else if (topic == "debug") {
+        std::cout << "debug" << std::endl;
+        std::cout << "USAGE:" << std::endl;
+        std::cout << "  debug -- start a GDB remote protocol debug server on localhost port 8008 (decimal)" << std::endl;
+        std::cout << "  debug [port] -- start the debug server on a localhost port, given in decimal unlike everything else" << std::endl;
+        std::cout << "  debug [path] -- start the debug server on a Unix socket (only an old socket at the path gets replaced)" << std::endl;
+        std::cout << "  debug off -- stop the debug server" << std::endl;
     } else {
         std::cout << "No help available for " << topic << std::endl;
     }
@@ -1,21 +1,41 @@
 #ifndef ALTAIR8800_MONITOR_H
 #define ALTAIR8800_MONITOR_H
 
+#include <array>
 #include <string>
 #include <vector>
 #include "../i8008.h"
+#include "../runner.h"
+#ifdef ALTAIR8800_DEBUG_SERVER
+#include "debugserver.h"
+#endif
 
 constexpr char MONITOR_PROMPT[] = "> ";
-const std::string LISTED_COMMANDS[] {"help", "quit", "examine", "deposit", "depositnext", "dump", "step", "load", "pc"};
+const std::string LISTED_COMMANDS[] {"help", "quit", "examine", "deposit", "depositnext", "dump", "step", "load", "pc", "run", "stop", "interrupt", "idle", "find", "fill", "move", "snapshot", "compare", "debug"};
 
 class Monitor {
     public:
         Intel8008 cpu;
+        Runner runner;
         explicit Monitor(Intel8008 cpu);
         void run();
 
     private:
         bool isRunning = true;
+        bool hasSnapshot = false;
+        std::array<uint8_t, RAM_SIZE> snapshot = {};
+#ifdef ALTAIR8800_DEBUG_SERVER
+        DebugServer debugServer;
+#endif
+        void execute(const std::vector<std::string>& splitCommand);
+        static bool changesMachine(const std::vector<std::string>& splitCommand);
+        void interrupt(const std::vector<std::string>& splitCommand);
+        void idle();
+        void find(const std::vector<std::string>& splitCommand);
+        void fill(const std::vector<std::string>& splitCommand);
+        void move(const std::vector<std::string>& splitCommand);
+        void compare(const std::vector<std::string>& splitCommand);
+        void debug(const std::vector<std::string>& splitCommand);
         void examine(const std::vector<std::string>& splitCommand);
         void dump(const std::vector<std::string>& splitCommand);
         void deposit(const std::vector<std::string>& splitCommand);
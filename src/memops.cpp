@@ -0,0 +1,114 @@
+#include <cstring>
+#include "memops.h"
+
+// ALTAIR8800_NO_SIMD forces the portable paths, so they can be tested on machines with SSE2
+#if defined(__SSE2__) && !defined(ALTAIR8800_NO_SIMD)
+#define ALTAIR8800_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * Compare 16 bytes.
+ * @return A mask with bit i set if the ith bytes differ
+ */
+static inline uint32_t differingBytes(const uint8_t* first, const uint8_t* second) {
+#ifdef ALTAIR8800_SSE2
+    __m128i a = _mm_loadu_si128((const __m128i*)first);
+    __m128i b = _mm_loadu_si128((const __m128i*)second);
+    return ~uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xffff;
+#else
+    uint64_t a[2], b[2];
+    std::memcpy(a, first, 16);
+    std::memcpy(b, second, 16);
+    if (a[0] == b[0] && a[1] == b[1]) return 0; // the usual case, skip the byte loop
+    uint32_t mask = 0;
+    for (int i = 0; i < 16; i++) {
+        if (first[i] != second[i]) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Find a byte pattern in memory.
+ * Candidates are picked by matching the first and last bytes of the pattern across a whole block at once,
+ * so only those need a full comparison.
+ * @param from Where to start looking
+ * @return The offset of the first match at or after from, or -1 if there isn't one
+ */
+long Altair8008Memory::find(const uint8_t* data, size_t length, const uint8_t* pattern, size_t patternLength, size_t from) {
+    if (patternLength == 0 || patternLength > length) return -1;
+    size_t last = length - patternLength; // last offset a match could start at
+    size_t i = from;
+#ifdef ALTAIR8800_SSE2
+    __m128i firstByte = _mm_set1_epi8(char(pattern[0]));
+    __m128i lastByte = _mm_set1_epi8(char(pattern[patternLength - 1]));
+    for (; i + 15 <= last; i += 16) {
+        __m128i firsts = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i lasts = _mm_loadu_si128((const __m128i*)(data + i + patternLength - 1));
+        uint32_t candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firsts, firstByte), _mm_cmpeq_epi8(lasts, lastByte)));
+        while (candidates) {
+            size_t offset = i + __builtin_ctz(candidates);
+            if (std::memcmp(data + offset, pattern, patternLength) == 0) return long(offset);
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    while (i <= last) {
+        // memchr is vectorised by the C library, so use it to get to the next candidate
+        const void* next = std::memchr(data + i, pattern[0], last - i + 1);
+        if (!next) break;
+        i = (const uint8_t*)next - data;
+        if (std::memcmp(data + i, pattern, patternLength) == 0) return long(i);
+        i++;
+    }
+    return -1;
+}
+
+void Altair8008Memory::fill(uint8_t* data, size_t length, uint8_t value) {
+    std::memset(data, value, length); // already vectorised by the C library
+}
+
+/**
+ * Copy a block of memory, which may overlap with where it's going.
+ */
+void Altair8008Memory::move(uint8_t* data, size_t source, size_t dest, size_t length) {
+    std::memmove(data + dest, data + source, length);
+}
+
+/**
+ * Compare two blocks of memory.
+ * @return Inclusive ranges of offsets that differ
+ */
+std::vector<std::pair<size_t, size_t>> Altair8008Memory::compare(const uint8_t* first, const uint8_t* second, size_t length) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    bool inRange = false;
+    size_t start = 0;
+    size_t block = 0;
+    for (; block + 16 <= length; block += 16) {
+        uint32_t mask = differingBytes(first + block, second + block);
+        if (mask == (inRange ? 0xffffu : 0u)) continue; // no range starts or ends in this block
+        for (size_t i = 0; i < 16; i++) {
+            bool differs = (mask >> i) & 1;
+            if (differs == inRange) continue;
+            if (differs) {
+                start = block + i;
+            } else {
+                ranges.emplace_back(start, block + i - 1);
+            }
+            inRange = differs;
+        }
+    }
+    for (; block < length; block++) {
+        bool differs = first[block] != second[block];
+        if (differs == inRange) continue;
+        if (differs) {
+            start = block;
+        } else {
+            ranges.emplace_back(start, block - 1);
+        }
+        inRange = differs;
+    }
+    if (inRange) ranges.emplace_back(start, length - 1);
+    return ranges;
+}
@@ -0,0 +1,20 @@
+#ifndef ALTAIR8800_MEMOPS_H
+#define ALTAIR8800_MEMOPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Bulk operations over guest memory, for the monitor and scripts.
+ * These work 16 bytes at a time with SSE2 where it's available, and a word at a time elsewhere.
+ */
+namespace Altair8008Memory {
+    long find(const uint8_t* data, size_t length, const uint8_t* pattern, size_t patternLength, size_t from = 0);
+    void fill(uint8_t* data, size_t length, uint8_t value);
+    void move(uint8_t* data, size_t source, size_t dest, size_t length);
+    std::vector<std::pair<size_t, size_t>> compare(const uint8_t* first, const uint8_t* second, size_t length);
+}
+
+#endif //ALTAIR8800_MEMOPS_H
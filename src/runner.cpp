@@ -0,0 +1,199 @@
+#include <algorithm>
+#include "runner.h"
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Check if everything the CPU can see matches between two sets of registers.
+ * Registers::operator= only copies values, so the pointer arrays are left out.
+ */
+static bool sameState(const Registers& first, const Registers& second) {
+    if (first.a != second.a || first.b != second.b || first.c != second.c || first.d != second.d ||
+        first.e != second.e || first.h != second.h || first.l != second.l || first.pc != second.pc ||
+        first.sp != second.sp || first.sign != second.sign || first.zero != second.zero ||
+        first.parity != second.parity || first.carry != second.carry) {
+        return false;
+    }
+    for (int i = 0; i < first.sp; i++) {
+        if (first.stack[i] != second.stack[i]) return false;
+    }
+    return true;
+}
+
+void IdleDetector::reset() {
+    armed = false;
+    snapshotInterval = 1;
+    sinceSnapshot = 0;
+}
+
+/**
+ * Look at the CPU after a step.
+ * @param cpu The CPU that just stepped
+ * @param previousPc The program counter before the step
+ * @return True if the CPU is going around a loop that can't end on its own
+ */
+bool IdleDetector::check(const Intel8008& cpu, uint16_t previousPc) {
+    if (cpu.registers.pc > previousPc) return false; // only a jump backwards (or onto itself) can close a loop
+    if (armed && cpu.memoryWrites == snapshotWrites && sameState(cpu.registers, snapshot)) {
+        return true;
+    }
+    if (!armed || ++sinceSnapshot >= snapshotInterval) {
+        snapshot = cpu.registers;
+        snapshotWrites = cpu.memoryWrites;
+        armed = true;
+        sinceSnapshot = 0;
+        snapshotInterval = std::min(snapshotInterval * 2, IDLE_MAX_LOOP);
+    }
+    return false;
+}
+
+Runner::Runner(Intel8008& cpu) : cpu(cpu) {
+}
+
+Runner::~Runner() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    wakeup.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+/**
+ * Take the CPU away from the runner thread. It gets interrupted between instructions, not at the end of a slice.
+ * Every other method expects the caller to be holding this lock.
+ * @return The held lock
+ */
+std::unique_lock<std::mutex> Runner::acquire() {
+    contenders++;
+    std::unique_lock<std::mutex> guard(lock);
+    contenders--;
+    return guard;
+}
+
+/**
+ * Let the CPU run freely, leaving the halted state if needed (like the RUN switch on the front panel).
+ */
+void Runner::start() {
+    if (!running) runStart = Clock::now();
+    running = true;
+    ignoreBreakpoint = true;
+    cpu.resume();
+    pendingEvent = true;
+    if (!thread.joinable()) thread = std::thread(&Runner::loop, this);
+    wakeup.notify_all();
+}
+
+void Runner::stop() {
+    auto now = Clock::now();
+    if (running) runTotal += now - runStart;
+    if (parked) {
+        // close the park here rather than when the thread gets around to waking, so it fits inside the run time
+        parkedTotal += now - parkStart;
+        parked = false;
+    }
+    running = false;
+    wakeup.notify_all();
+}
+
+/**
+ * Tell a parked CPU that something outside of it may have changed and it should have another look.
+ */
+void Runner::wake() {
+    pendingEvent = true;
+    wakeup.notify_all();
+}
+
+void Runner::interrupt(uint8_t opcode) {
+    cpu.interrupt(opcode);
+    wake();
+}
+
+bool Runner::isRunning() {
+    return running;
+}
+
+bool Runner::isParked() {
+    return parked;
+}
+
+/**
+ * @return How long the CPU thread has spent parked, including the current park
+ */
+std::chrono::nanoseconds Runner::parkedTime() {
+    return parked ? parkedTotal + (Clock::now() - parkStart) : parkedTotal;
+}
+
+/**
+ * @return How long the CPU has been told to run for, parked or not
+ */
+std::chrono::nanoseconds Runner::runTime() {
+    return running ? runTotal + (Clock::now() - runStart) : runTotal;
+}
+
+unsigned long Runner::parkCount() {
+    return parks;
+}
+
+void Runner::setBreakpoint(uint16_t address, bool enabled) {
+    breakpoints[address & 0x3fff] = enabled;
+}
+
+/**
+ * Set what gets called when the CPU stops at a breakpoint or halts while running.
+ * It's called from the runner thread with the lock held, so it shouldn't do much.
+ */
+void Runner::setStopHandler(std::function<void(StopReason)> handler) {
+    stopHandler = std::move(handler);
+}
+
+void Runner::loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!quit) {
+        if (pendingEvent) {
+            pendingEvent = false;
+            idleDetected = false;
+            idle.reset();
+        }
+        if (!running) {
+            wakeup.wait(guard, [this] { return quit || running; });
+            continue;
+        }
+        if (cpu.isHalted() || idleDetected) {
+            if (!stalled && cpu.isHalted() && stopHandler) stopHandler(StopReason::Halt); // only when it first halts
+            parked = true;
+            if (!stalled) {
+                stalled = true;
+                parks++;
+            }
+            parkStart = Clock::now();
+            wakeup.wait(guard, [this] { return quit || !running || pendingEvent; });
+            if (parked) parkedTotal += Clock::now() - parkStart;
+            parked = false;
+            continue;
+        }
+        bool checkBreakpoints = breakpoints.any();
+        for (int i = 0; i < RUN_SLICE && !cpu.isHalted(); i++) {
+            uint16_t pc = cpu.registers.pc;
+            if (checkBreakpoints && breakpoints[pc & 0x3fff] && !ignoreBreakpoint) {
+                stop();
+                if (stopHandler) stopHandler(StopReason::Breakpoint);
+                break;
+            }
+            ignoreBreakpoint = false;
+            cpu.step();
+            stalled = false;
+            if (idle.check(cpu, pc)) {
+                idleDetected = true;
+                break;
+            }
+            if (contenders.load(std::memory_order_relaxed) > 0) break;
+        }
+        if (contenders.load() > 0) {
+            // std::mutex isn't fair, so step aside until whoever wants the CPU has had it
+            guard.unlock();
+            while (contenders.load() > 0) std::this_thread::yield();
+            guard.lock();
+        }
+    }
+}
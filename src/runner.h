@@ -0,0 +1,90 @@
+#ifndef ALTAIR8800_RUNNER_H
+#define ALTAIR8800_RUNNER_H
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "i8008.h"
+
+static constexpr int RUN_SLICE = 4096; // instructions run between checks for anyone else wanting the CPU
+static constexpr int IDLE_MAX_LOOP = 1024; // longest loop (in backwards jumps per time around) the IdleDetector catches
+
+/**
+ * Spots when the CPU is stuck in a loop it can't leave without outside help.
+ * Only backwards jumps (including returns) can close a loop, so the state is looked at after each of them. If the CPU
+ * comes back to a remembered state with the same registers and without having stored anything, the machine will keep
+ * going around forever (self-jumps, polling loops waiting on a port, polling loops that call subroutines, etc).
+ * The state is remembered Brent style, at doubling intervals of backwards jumps, so loops with several jumps per
+ * time around are caught too. The interval stops growing at IDLE_MAX_LOOP so that a long busy run doesn't slow down
+ * spotting an idle loop after it.
+ */
+class IdleDetector {
+    public:
+        void reset();
+        bool check(const Intel8008& cpu, uint16_t previousPc);
+
+    private:
+        bool armed = false;
+        Registers snapshot;
+        uint32_t snapshotWrites = 0;
+        int snapshotInterval = 1; // backwards jumps between snapshots
+        int sinceSnapshot = 0;
+};
+
+// why the runner stopped the CPU by itself
+enum class StopReason {
+    Breakpoint,
+    Halt
+};
+
+/**
+ * Runs the CPU freely on its own thread.
+ * When the CPU halts or the IdleDetector trips, the thread is parked on a condition variable instead of spinning,
+ * and stays there until something from the outside (an interrupt, a monitor command, I/O) calls wake().
+ */
+class Runner {
+    public:
+        explicit Runner(Intel8008& cpu);
+        ~Runner();
+        std::unique_lock<std::mutex> acquire();
+        void start();
+        void stop();
+        void wake();
+        void interrupt(uint8_t opcode);
+        bool isRunning();
+        bool isParked();
+        std::chrono::nanoseconds parkedTime();
+        std::chrono::nanoseconds runTime();
+        unsigned long parkCount();
+        void setBreakpoint(uint16_t address, bool enabled);
+        void setStopHandler(std::function<void(StopReason)> handler);
+
+    private:
+        Intel8008& cpu;
+        IdleDetector idle;
+        std::mutex lock;
+        std::condition_variable wakeup;
+        std::thread thread;
+        std::atomic<int> contenders{0}; // threads waiting in acquire()
+        bool running = false; // the user wants the CPU to run
+        bool parked = false;
+        bool idleDetected = false;
+        bool stalled = false; // halted or idle since the last instruction, so re-parking isn't a new park
+        bool pendingEvent = false;
+        bool quit = false;
+        bool ignoreBreakpoint = false; // so that running from a breakpoint doesn't stop straight away
+        std::bitset<RAM_SIZE> breakpoints;
+        std::function<void(StopReason)> stopHandler;
+        unsigned long parks = 0;
+        std::chrono::steady_clock::time_point parkStart;
+        std::chrono::steady_clock::time_point runStart;
+        std::chrono::nanoseconds parkedTotal{0};
+        std::chrono::nanoseconds runTotal{0};
+        void loop();
+};
+
+#endif //ALTAIR8800_RUNNER_H
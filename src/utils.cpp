@@ -1,3 +1,4 @@
+#include <cctype>
 #include <sstream>
 #include "utils.h"
 
@@ -10,3 +11,17 @@ std::vector<std::string> Altair8008Utils::splitString(const std::string& toSplit
     }
     return res;
 }
+
+/**
+ * Parse a string of hex digit pairs ("c30010") into bytes.
+ * @param bytes Parsed bytes get appended to this
+ * @return False if the string isn't made of whole hex bytes
+ */
+bool Altair8008Utils::parseHexBytes(const std::string& hex, std::vector<uint8_t>& bytes) {
+    if (hex.empty() || hex.size() % 2 != 0) return false;
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        if (!isxdigit(hex[i]) || !isxdigit(hex[i + 1])) return false;
+        bytes.push_back(uint8_t(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return true;
+}
@@ -1,11 +1,13 @@
 #ifndef ALTAIR8800_UTILS_H
 #define ALTAIR8800_UTILS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace Altair8008Utils {
     std::vector<std::string> splitString(const std::string& toSplit, char delim = ' ');
+    bool parseHexBytes(const std::string& hex, std::vector<uint8_t>& bytes);
 }
 
 #endif //ALTAIR8800_UTILS_H
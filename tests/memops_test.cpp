@@ -0,0 +1,130 @@
+/*
+ * Checks the block kernels in memops.cpp against plain byte-at-a-time versions.
+ * Built twice by CMake: once as it normally compiles, and once with ALTAIR8800_NO_SIMD for the portable paths.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "memops.h"
+
+using Ranges = std::vector<std::pair<size_t, size_t>>;
+
+static int failures = 0;
+
+static long naiveFind(const uint8_t* data, size_t length, const uint8_t* pattern, size_t patternLength, size_t from) {
+    if (patternLength == 0 || patternLength > length) return -1;
+    for (size_t i = from; i + patternLength <= length; i++) {
+        if (std::memcmp(data + i, pattern, patternLength) == 0) return long(i);
+    }
+    return -1;
+}
+
+static Ranges naiveCompare(const uint8_t* first, const uint8_t* second, size_t length) {
+    Ranges ranges;
+    for (size_t i = 0; i < length;) {
+        if (first[i] == second[i]) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < length && first[i] != second[i]) i++;
+        ranges.emplace_back(start, i - 1);
+    }
+    return ranges;
+}
+
+static void checkFind(const std::string& name, const uint8_t* data, size_t length, const uint8_t* pattern,
+                      size_t patternLength, size_t from = 0) {
+    long expected = naiveFind(data, length, pattern, patternLength, from);
+    long got = Altair8008Memory::find(data, length, pattern, patternLength, from);
+    if (got != expected) {
+        fprintf(stderr, "find %s: expected %ld, got %ld\n", name.c_str(), expected, got);
+        failures++;
+    }
+}
+
+static void checkCompare(const std::string& name, const uint8_t* first, const uint8_t* second, size_t length) {
+    Ranges expected = naiveCompare(first, second, length);
+    Ranges got = Altair8008Memory::compare(first, second, length);
+    if (got != expected) {
+        fprintf(stderr, "compare %s: expected %zu ranges, got %zu\n", name.c_str(), expected.size(), got.size());
+        failures++;
+    }
+}
+
+/**
+ * Differences that start and end right on and around the 16 byte block edges, and in the scalar tail.
+ */
+static void compareEdges() {
+    const size_t edges[][2] = {
+        {0, 15}, {16, 31}, {0, 31}, {15, 16}, {15, 15}, {16, 16}, {31, 32}, {1, 14},
+        {0, 63}, {48, 63}, {60, 66}, {64, 66}, {66, 66}, {17, 47}
+    };
+    for (size_t length : {64, 67, 80}) {
+        for (const auto& edge : edges) {
+            if (edge[1] >= length) continue;
+            std::vector<uint8_t> first(length, 0), second(length, 0);
+            for (size_t i = edge[0]; i <= edge[1]; i++) second[i] = 1;
+            checkCompare("[" + std::to_string(edge[0]) + ", " + std::to_string(edge[1]) + "] of " + std::to_string(length),
+                         first.data(), second.data(), length);
+        }
+        std::vector<uint8_t> first(length, 0), second(length, 1);
+        checkCompare("everything of " + std::to_string(length), first.data(), second.data(), length);
+    }
+}
+
+/**
+ * Patterns sitting in the last 15 bytes, where the block loop has to hand over to the scalar one.
+ */
+static void findEdges() {
+    const size_t length = 64;
+    for (size_t patternLength = 1; patternLength <= 4; patternLength++) {
+        for (size_t at = length - 16 - patternLength; at + patternLength <= length; at++) {
+            std::vector<uint8_t> data(length, 0);
+            std::vector<uint8_t> pattern(patternLength, 0xaa);
+            std::memcpy(data.data() + at, pattern.data(), patternLength);
+            std::string name = std::to_string(patternLength) + " bytes at " + std::to_string(at);
+            checkFind(name, data.data(), length, pattern.data(), patternLength);
+            checkFind(name + " from it", data.data(), length, pattern.data(), patternLength, at);
+            checkFind(name + " from after it", data.data(), length, pattern.data(), patternLength, at + 1);
+        }
+    }
+    uint8_t data[16] = {0};
+    uint8_t whole[16] = {0};
+    checkFind("pattern as long as the data", data, 16, whole, 16);
+    checkFind("pattern longer than the data", data, 15, whole, 16);
+}
+
+static void randomised() {
+    std::mt19937 random(8008);
+    std::vector<uint8_t> first(300), second(300);
+    for (int round = 0; round < 5000; round++) {
+        size_t length = random() % first.size() + 1;
+        // small alphabets so matches and differences are common
+        for (size_t i = 0; i < length; i++) {
+            first[i] = random() % 3;
+            second[i] = random() % 4 ? first[i] : random() % 3;
+        }
+        uint8_t pattern[4];
+        size_t patternLength = random() % 4 + 1;
+        for (uint8_t& byte : pattern) byte = random() % 3;
+        size_t from = random() % (length + 1);
+        checkFind("round " + std::to_string(round), first.data(), length, pattern, patternLength, from);
+        checkCompare("round " + std::to_string(round), first.data(), second.data(), length);
+    }
+}
+
+int main() {
+    compareEdges();
+    findEdges();
+    randomised();
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All memops checks passed\n");
+    return 0;
+}